@@ -1,9 +1,20 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <fcntl.h>
 #include <dirent.h>
 #include <wait.h>
+#include <sched.h>
+#include <signal.h>
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/mount.h>
+#include <sys/resource.h>
 
 #define STDERR 2
 #define CONFIG_MAX_LENGTH 160
@@ -18,6 +29,54 @@
 
 #define SYSTEM_FAIL -1
 
+#define RUN_PENDING 0
+#define RUN_WAITING 1
+#define RUN_RUNNING 2
+#define RUN_DONE 3
+
+#define RUN_TIME_LIMIT 5
+#define COMPILE_ARGS_LENGTH 8
+#define HASH_BUFFER_SIZE 4096
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+#define SANDBOX_MAX_RUNS 64
+#define SANDBOX_POLL_INTERVAL_MS 10
+#define SANDBOX_FDS_COUNT 2
+#define SANDBOX_MAX_FILE_SIZE (64L << 20)
+#define MILLISECONDS_IN_SECOND 1000
+
+#define COHORT_HEADER "cohort_pch.h"
+#define COHORT_PRECOMPILED_HEADER "cohort_pch.h.gch"
+#define COHORT_MAX_HEADERS 32
+
+#define REPORTS_FOLDER "reports"
+#define DIFF_MAX_EDITS 256
+#define DIFF_MAX_LINES 200
+#define DIFF_CONTEXT_LINES 3
+#define DIFF_PREVIEW_LENGTH 120
+#define DIFF_MAX_INPUT_SIZE (1L << 20)
+#define DIFF_EQUAL ' '
+#define DIFF_DELETE '-'
+#define DIFF_INSERT '+'
+
+#define DIFFERENTIAL_FOLDER "differential"
+#define DIFFERENTIAL_DEFAULT_SEEDS 100
+
+#define CONTROLLER_INTERVAL_MS 500
+#define CONTROLLER_BACKOFF_HOLD_MS 5000
+#define CONTROLLER_CPU_PRESSURE_HIGH 25.0
+#define CONTROLLER_CPU_PRESSURE_LOW 5.0
+#define CONTROLLER_MEMORY_PRESSURE_HIGH 10.0
+#define CONTROLLER_MEMORY_PRESSURE_LOW 1.0
+#define CONTROLLER_LOAD_HIGH 1.25
+#define CONTROLLER_LOAD_LOW 0.75
+#define CONTROLLER_STRETCH_HIGH 1.5
+#define CONTROLLER_STRETCH_LOW 1.15
+#define CONTROLLER_STRETCH_WEIGHT 0.25
+#define CONTROLLER_MIN_CPU_MS 20
+#define PROC_FILE_LENGTH 256
+
 
 /**
  * The students data structure
@@ -31,8 +90,124 @@ typedef struct studentInfo {
     char dirPath[STRING_MAX_LENGTH];
     char cFilePath[STRING_MAX_LENGTH];
     char compiledFileName[STRING_MAX_LENGTH];
+    int isDeduplicated;
+    unsigned int includedHeaders;
+    char outputFileName[STRING_MAX_LENGTH];
+    int failingSeed;
+    char differentialInfo[STRING_MAX_LENGTH];
 } studentInfo;
 
+/**
+ * A line of an output, with its hash to speed the comparisons up.
+ * only the last line of an output may lack its newline.
+ */
+typedef struct diffLine {
+    const char *text;
+    int length;
+    int hasNewline;
+    unsigned long long hash;
+} diffLine;
+
+/**
+ * A system header included by the submissions,
+ * and the amount of submissions including it.
+ */
+typedef struct cohortHeader {
+    char name[STRING_MAX_LENGTH];
+    int count;
+} cohortHeader;
+
+/**
+ * A memoized execution verdict, keyed by the compiled binary,
+ * the test input and the run limits.
+ * the verdict itself is the grade & info of the student at sourceIndex,
+ * the binary is kept so a matching hash can be confirmed byte for byte.
+ */
+typedef struct executionCacheEntry {
+    unsigned long long binaryHash;
+    char binaryPath[STRING_MAX_LENGTH];
+    unsigned long long inputHash;
+    int timeLimit;
+    int sourceIndex;
+} executionCacheEntry;
+
+/**
+ * The zygote process running the compiled c files,
+ * it is isolated once (namespaces & mounts) and forks a cheap child per run.
+ */
+typedef struct sandbox {
+    pid_t pid;
+    int controlSocket;
+    int isIsolated;
+} sandbox;
+
+/**
+ * A request to run a binary, sent to the zygote along with its stdin & stdout.
+ */
+typedef struct sandboxRequest {
+    int runId;
+    int timeLimit;
+    char binaryPath[STRING_MAX_LENGTH];
+    char argument[STRING_MAX_LENGTH];
+} sandboxRequest;
+
+/**
+ * The result of a run, sent back by the zygote once the run is over,
+ * or right away if the run couldn't be started.
+ */
+typedef struct sandboxResult {
+    int runId;
+    int isStartFailed;
+    int timedOut;
+    int status;
+    long elapsedMs;
+    struct rusage usage;
+} sandboxResult;
+
+/**
+ * A run the zygote is currently waiting on.
+ */
+typedef struct sandboxRun {
+    pid_t pid;
+    int runId;
+    int timedOut;
+    long startMs;
+    long deadlineMs;
+} sandboxRun;
+
+/**
+ * The adaptive concurrency controller, deciding how many compiles & runs are in flight
+ * from the pressure stall info, the load average & the latency of the finished jobs.
+ */
+typedef struct concurrencyController {
+    int limit;
+    int maxLimit;
+    int cpus;
+    double stretch;
+    long lastAdjustMs;
+    long lastBackoffMs;
+} concurrencyController;
+
+/**
+ * A compilation in flight.
+ */
+typedef struct compileJob {
+    pid_t pid;
+    int usesCohortHeader;
+    long startMs;
+} compileJob;
+
+/**
+ * The state of a submission in the grading loop,
+ * one of RUN_PENDING, RUN_WAITING (for an identical binary), RUN_RUNNING & RUN_DONE.
+ */
+typedef struct submissionRun {
+    unsigned long long binaryHash;
+    int isHashed;
+    int isRetried;
+    int state;
+} submissionRun;
+
 void printError();
 
 char *strCopy(char *dest, const char *src);
@@ -53,7 +228,8 @@ void readLineFromFile(int file, char *array);
 
 void closeFile(int file);
 
-void readConfigFile(char *const *argv, char *studentFolders, char *testInput, char *correctOutPut);
+void readConfigFile(char *const *argv, char *studentFolders, char *testInput, char *correctOutPut,
+                    char *generator, char *reference, char *seeds);
 
 int countSubmittedFolders(char *folders);
 
@@ -61,18 +237,85 @@ void assignFolderAndName(studentInfo *pStudents,char *folders);
 
 void findStudentsCFiles(int submissionsCount, studentInfo *myStudents);
 
-void compileAllCFiles(int submissionsCount, studentInfo *myStudents);
+void compileAllCFiles(int submissionsCount, studentInfo *myStudents, concurrencyController *pController);
+
+pid_t spawnCompilation(studentInfo *myStudents, int i, int usesCohortHeader);
+
+unsigned int buildCohortHeader(int submissionsCount, studentInfo *myStudents);
+
+unsigned int scanIncludedHeaders(char *cFilePath, cohortHeader *headers, int *headersCount);
+
+char *readWholeFile(const char *filePath, long *size);
+
+char *readFileHead(const char *filePath, long maxSize, long *size, int *isTruncated);
+
+void writeDiffReports(studentInfo *pStudents, int submissionsCount, char *outputFilePath);
+
+void clearReportsFolder();
+
+void writeDiffReport(studentInfo *pStudents, int i, char *expected, long expectedSize, int isExpectedTruncated);
+
+void writeFirstDivergence(int report, char *expected, long expectedSize, char *actual, long actualSize);
+
+int splitLines(char *text, long size, diffLine **lines);
+
+int linesEqual(diffLine *line1, diffLine *line2);
+
+int diffLines(diffLine *expected, int expectedCount, diffLine *actual, int actualCount, char *ops, int *trace);
+
+void writeUnifiedDiff(int report, char *ops, int opsCount, diffLine *expected, diffLine *actual);
+
+void writeHunkRange(int report, char sign, int start, int length);
 
 char* findCFilePath(char *cpath);
 
-void executeSubmissions(studentInfo *pStudents, int submissionsCount,
-                        char *inputFilePath, char *outputFilePath);
+void executeSubmissions(studentInfo *pStudents, int submissionsCount, char *inputFilePath,
+                        char *outputFilePath, sandbox *pSandbox, concurrencyController *pController);
+
+char *runOutputFileName(char *fileName, int i);
 
 void gradeStudent(studentInfo *pStudents, int i, char *grade, char *info);
 
 int compareOutputs(studentInfo *pStudents, const char *outputFilePath, int i, int retCode, int *value,char *outputFileName);
 
-int executeCFile(char *inputFilePath, char **args, int retCode,int i,char *outputFileName);
+int executeCFile(int binary, char *binaryPath, char *argument, int inputFD, int outputFD);
+
+void startSandbox(sandbox *pSandbox);
+
+void stopSandbox(sandbox *pSandbox);
+
+void sandboxSubmit(sandbox *pSandbox, int runId, char *binaryPath, char *argument,
+                   int inputFD, int outputFD, int timeLimit);
+
+void sandboxCollect(sandbox *pSandbox, sandboxResult *result);
+
+void runZygote(int controlSocket);
+
+int mapZygoteUser(uid_t uid, gid_t gid);
+
+int mountSandboxFilesystem();
+
+void isolateRunTmp();
+
+void serveSandboxRuns(int controlSocket, int isIsolated);
+
+int writeProcFile(const char *filePath, const char *content);
+
+long currentTimeMs();
+
+int runDifferentialTests(studentInfo *pStudents, int submissionsCount, char *generator, char *reference,
+                         int seedsCount, sandbox *pSandbox, concurrencyController *pController);
+
+int runDifferentialBatch(sandbox *pSandbox, concurrencyController *pController, char *binaryPath,
+                         int firstSeed, int count, int isGenerator);
+
+void removeDifferentialFiles(int seedsCount);
+
+char *seedFilePath(char *path, char *kind, int seed);
+
+int parseSeedsCount(char *seeds);
+
+void writeDifferentialCSV(studentInfo *pStudents, int submissionsCount);
 
 void writeToCSV(studentInfo *pStudents, int count);
 
@@ -80,10 +323,35 @@ char *studentToString(studentInfo *pStudents, int i);
 
 void executeCommand(char **args);
 
+pid_t spawnCommand(char **args);
+
+void initController(concurrencyController *pController);
+
+int controllerLimit(concurrencyController *pController);
+
+void controllerObserve(concurrencyController *pController, long elapsedMs, struct rusage *usage, int timeLimit);
+
+void controllerBackoff(concurrencyController *pController);
+
+long usageCpuMs(struct rusage *usage);
+
+int isRunStretched(long elapsedMs, struct rusage *usage);
+
+double readPressure(const char *filePath);
+
+double readLoadAverage();
+
 int checkCompileSuccess(char *compiledFile,char *compiledFilePath);
 
 int string_ends_with(char * str, char * suffix);
 
+int hashFile(const char *filePath, unsigned long long *hash);
+
+int findCachedExecution(executionCacheEntry *cache, int cacheSize, unsigned long long binaryHash,
+                        char *binaryPath, unsigned long long inputHash, int timeLimit);
+
+int filesEqual(const char *filePath1, const char *filePath2);
+
 /**
  * The main function.
  * @param argc - number of provided command line arguments.
@@ -100,8 +368,21 @@ int main(int argc, char *argv[]) {
     char testInput[CONFIG_MAX_LENGTH + 1];
     //the location of the text file containing the correct output.
     char correctOutPut[CONFIG_MAX_LENGTH + 1];
+    //optional - the generator of random inputs, the reference solution & the amount of seeds.
+    char generator[CONFIG_MAX_LENGTH + 1];
+    char reference[CONFIG_MAX_LENGTH + 1];
+    char seeds[CONFIG_MAX_LENGTH + 1];
+
+    readConfigFile(argv, studentFolders, testInput, correctOutPut, generator, reference, seeds);
+    int seedsCount = parseSeedsCount(seeds);
 
-    readConfigFile(argv, studentFolders, testInput, correctOutPut);
+    //starting the zygote before allocating anything, so it forks a small process.
+    sandbox mySandbox;
+    startSandbox(&mySandbox);
+
+    //deciding how many compiles & runs are in flight as the grading goes.
+    concurrencyController myController;
+    initController(&myController);
 
     //checking how much students\folders there are to go through and grade.
     int submissionsCount = countSubmittedFolders(studentFolders);
@@ -120,13 +401,27 @@ int main(int argc, char *argv[]) {
     findStudentsCFiles(submissionsCount, myStudents);
 
     //compile the c files.
-    compileAllCFiles(submissionsCount, myStudents);
+    compileAllCFiles(submissionsCount, myStudents, &myController);
+
+    //test the .out files against the reference solution on generated inputs.
+    int isDifferential = 0;
+    if (generator[0] != '\0') {
+        isDifferential = runDifferentialTests(myStudents, submissionsCount, generator, reference, seedsCount,
+                                              &mySandbox, &myController);
+    }
 
     //execute all the .out files & grade them upon performance.
-    executeSubmissions(myStudents, submissionsCount, testInput, correctOutPut);
+    executeSubmissions(myStudents, submissionsCount, testInput, correctOutPut, &mySandbox, &myController);
+    stopSandbox(&mySandbox);
+
+    //explain the non identical outputs, after the grading loop is done.
+    writeDiffReports(myStudents, submissionsCount, correctOutPut);
 
     //write the score according to result.
     writeToCSV(myStudents,submissionsCount);
+    if (isDifferential == 1) {
+        writeDifferentialCSV(myStudents, submissionsCount);
+    }
 
     //freeing the allocated data before returning.
     free(myStudents);
@@ -135,228 +430,1446 @@ int main(int argc, char *argv[]) {
 
 /**
  * The function executes each of the compiled c files & grades them.
+ * the runs are kept in flight up to the limit of the concurrency controller.
  * @param pStudents - an array holding all the information of the studentInfo submissions.
  * @param submissionsCount - the amount of submissions we need to process.
  * @param inputFilePath - path to the input that we would like to use.
  * @param outputFilePath - path to the correct output we are expecting.
+ * @param pSandbox - the zygote running the compiled c files.
+ * @param pController - the controller deciding how many runs are in flight.
  */
-void executeSubmissions(studentInfo *pStudents, int submissionsCount,
-                        char *inputFilePath, char *outputFilePath) {
+void executeSubmissions(studentInfo *pStudents, int submissionsCount, char *inputFilePath,
+                        char *outputFilePath, sandbox *pSandbox, concurrencyController *pController) {
+    //the input is shared by every submission, so it is hashed only once.
+    unsigned long long inputHash;
+    if (hashFile(inputFilePath, &inputHash) == 0) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+    executionCacheEntry *cache = (executionCacheEntry *)malloc(submissionsCount * sizeof(executionCacheEntry));
+    submissionRun *runs = (submissionRun *)malloc(submissionsCount * sizeof(submissionRun));
+    if ((cache == NULL || runs == NULL) && submissionsCount > 0) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+    int cacheSize = 0;
     for (int i = 0; i < submissionsCount; ++i) {
+        runs[i].state = RUN_PENDING;
+        runs[i].isRetried = 0;
+        runs[i].isHashed = pStudents[i].isGraded != 1
+                           && hashFile(pStudents[i].compiledFileName, &runs[i].binaryHash) == 1;
+    }
 
-        if(pStudents[i].isGraded == 1){
-            continue;
+    //next is the first submission that may still be pending.
+    int next = 0;
+    int inFlight = 0;
+    while (next < submissionsCount || inFlight > 0) {
+        //submitting runs up to the limit.
+        while (next < submissionsCount && inFlight < controllerLimit(pController)) {
+            int i = next;
+            if(pStudents[i].isGraded == 1 || runs[i].state != RUN_PENDING){
+                next++;
+                continue;
+            }
+
+            //reuse the verdict of an identical binary that already ran on the same input.
+            if (runs[i].isHashed == 1) {
+                int source = findCachedExecution(cache, cacheSize, runs[i].binaryHash,
+                                                 pStudents[i].compiledFileName, inputHash, RUN_TIME_LIMIT);
+                if (source != SYSTEM_FAIL) {
+                    unlink(pStudents[i].compiledFileName);
+                    gradeStudent(pStudents, i, pStudents[source].grade, pStudents[source].info);
+                    pStudents[i].isDeduplicated = 1;
+                    strCopy(pStudents[i].outputFileName, pStudents[source].outputFileName);
+                    runs[i].state = RUN_DONE;
+                    next++;
+                    continue;
+                }
+                //an identical binary is still running, waiting for its verdict & moving on meanwhile.
+                int j = 0;
+                while (j < submissionsCount && !(runs[j].state == RUN_RUNNING && runs[j].isHashed == 1
+                                                 && runs[j].binaryHash == runs[i].binaryHash)) {
+                    j++;
+                }
+                if (j < submissionsCount) {
+                    runs[i].state = RUN_WAITING;
+                    next++;
+                    continue;
+                }
+            }
+
+            char string[STRING_MAX_LENGTH];
+            strCopy(string, "./");
+            strConcatenate(string, pStudents[i].compiledFileName);
+
+            char array[STRING_MAX_LENGTH];
+            int programOutputFD = open(runOutputFileName(array, i), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+            int programInputFD = open(inputFilePath, O_RDONLY);
+            if (programInputFD < 0 || programOutputFD < 0) {
+                printError();
+                exit(SYSTEM_FAIL);
+            }
+
+            //the zygote forks an isolated child for the compiled c file & waits on it.
+            sandboxSubmit(pSandbox, i, string, NULL, programInputFD, programOutputFD, RUN_TIME_LIMIT);
+            closeFile(programInputFD);
+            closeFile(programOutputFD);
+            runs[i].state = RUN_RUNNING;
+            inFlight++;
+            next++;
         }
-        //preparing an array for the command.
-        char *args[ARRAY_OF_COMMANDS];
-        for (int j = 0; j < ARRAY_OF_COMMANDS; ++j) {
-            args[j] = NULL;
+        if (inFlight == 0) {
+            continue;
         }
-        char string[STRING_MAX_LENGTH];
-        strCopy(string, "./");
-        strConcatenate(string, pStudents[i].compiledFileName);
-        args[0] = string;
 
+        sandboxResult result;
+        sandboxCollect(pSandbox, &result);
+        int i = result.runId;
+        runs[i].state = RUN_DONE;
+        inFlight--;
+        //the submissions waiting for this binary are pending again, they either find its verdict
+        //in the cache or, if it wasn't memoized, the first of them runs.
+        for (int j = 0; j < submissionsCount; ++j) {
+            if (runs[i].isHashed == 1 && runs[j].state == RUN_WAITING
+                && runs[j].binaryHash == runs[i].binaryHash) {
+                runs[j].state = RUN_PENDING;
+                next = j < next ? j : next;
+            }
+        }
+        controllerObserve(pController, result.elapsedMs, &result.usage, RUN_TIME_LIMIT);
 
         char array[STRING_MAX_LENGTH];
-        strCopy(array,"output");
-        char itoaArray[STRING_MAX_LENGTH];
-        itoa(i,itoaArray);
-        strConcatenate(array,itoaArray);
-        strConcatenate(array,".txt");
-
-        //forking the main process to execute the compiled c file on the child process.
-        int stat, retCode;
-        pid_t pid;
-        pid = fork();
-
-        // execute the c file in the child process.
-        if (pid == 0) {
-            retCode = executeCFile(inputFilePath, args, retCode,i,array);
-
-        }else{
-            int sleepTimer = 0;
-            int status;
-            pid_t returnPid;
-
-            for (int j = 0; j < 5; ++j) {
-                sleep(1);
-                returnPid = waitpid(pid, &status, WNOHANG);
-                if(returnPid != 0){
-                    int a = unlink(pStudents[i].compiledFileName);
-                    break;
+        runOutputFileName(array, i);
+        //a run that timed out while starved of cpu is run once more, after the controller backed off.
+        if (result.timedOut == 1 && runs[i].isRetried == 0 && isRunStretched(result.elapsedMs, &result.usage)) {
+            runs[i].isRetried = 1;
+            runs[i].state = RUN_PENDING;
+            next = i < next ? i : next;
+            continue;
+        }
+        //if temp.out was still running when the time was up.
+        if (result.timedOut == 1) {
+            unlink(array);
+            gradeStudent(pStudents,i, "0", "TIMEOUT");
+        } else {
+            int status = result.status;
+            compareOutputs(pStudents, outputFilePath, i, 0, &status, array);
+        }
+
+        //completed runs are memoized, and so are timeouts of runs that weren't starved of cpu,
+        //an identical binary would time out just the same. a starved timeout depends on the machine load.
+        if (runs[i].isHashed == 1 && pStudents[i].isGraded == 1 && result.isStartFailed == 0
+            && (result.timedOut == 0 || isRunStretched(result.elapsedMs, &result.usage) == 0)) {
+            cache[cacheSize].binaryHash = runs[i].binaryHash;
+            strCopy(cache[cacheSize].binaryPath, pStudents[i].compiledFileName);
+            cache[cacheSize].inputHash = inputHash;
+            cache[cacheSize].timeLimit = RUN_TIME_LIMIT;
+            cache[cacheSize].sourceIndex = i;
+            cacheSize++;
+        } else {
+            unlink(pStudents[i].compiledFileName);
+        }
+    }
+    //the memoized binaries were kept for the comparisons up to now.
+    for (int i = 0; i < cacheSize; ++i) {
+        unlink(cache[i].binaryPath);
+    }
+    free(runs);
+    free(cache);
+}
+
+/**
+ * the function builds the name of the file holding the output of a submission.
+ * @param fileName - the location we would like to save the name to.
+ * @param i - the number of the student.
+ * @return - a pointer to the name.
+ */
+char *runOutputFileName(char *fileName, int i) {
+    char itoaArray[STRING_MAX_LENGTH];
+    strCopy(fileName,"output");
+    itoa(i,itoaArray);
+    strConcatenate(fileName,itoaArray);
+    strConcatenate(fileName,".txt");
+    return fileName;
+}
+
+/**
+ * the function looks for a memoized execution matching the passed key.
+ * a matching hash is only a candidate, the binaries are compared byte for byte before it is reused.
+ * @param cache - the array of memoized executions.
+ * @param cacheSize - the amount of entries in the cache.
+ * @param binaryHash - the hash of the compiled c file.
+ * @param binaryPath - the compiled c file.
+ * @param inputHash - the hash of the test input.
+ * @param timeLimit - the time limit the run is allowed.
+ * @return - the index of the student holding the verdict, else SYSTEM_FAIL.
+ */
+int findCachedExecution(executionCacheEntry *cache, int cacheSize, unsigned long long binaryHash,
+                        char *binaryPath, unsigned long long inputHash, int timeLimit) {
+    for (int i = 0; i < cacheSize; ++i) {
+        if (cache[i].binaryHash == binaryHash && cache[i].inputHash == inputHash
+            && cache[i].timeLimit == timeLimit && filesEqual(cache[i].binaryPath, binaryPath) == 1) {
+            return cache[i].sourceIndex;
+        }
+    }
+    return SYSTEM_FAIL;
+}
+
+/**
+ * the function compares the content of two files.
+ * @param filePath1
+ * @param filePath2
+ * @return - 1 if the files are identical, else 0 (also if either couldn't be read).
+ */
+int filesEqual(const char *filePath1, const char *filePath2) {
+    char buffer1[HASH_BUFFER_SIZE];
+    char buffer2[HASH_BUFFER_SIZE];
+    struct stat stat1;
+    struct stat stat2;
+    int file1 = open(filePath1, O_RDONLY);
+    int file2 = open(filePath2, O_RDONLY);
+    int isEqual = file1 >= 0 && file2 >= 0 && fstat(file1, &stat1) == 0 && fstat(file2, &stat2) == 0
+                  && stat1.st_size == stat2.st_size;
+
+    while (isEqual) {
+        int bytesRead1 = read(file1, buffer1, HASH_BUFFER_SIZE);
+        int total = 0;
+        int bytesRead2;
+        //the second file is read up to the same amount, so the chunks line up.
+        while (bytesRead1 > 0 && total < bytesRead1
+               && (bytesRead2 = read(file2, buffer2 + total, bytesRead1 - total)) > 0) {
+            total += bytesRead2;
+        }
+        if (bytesRead1 <= 0 || total != bytesRead1) {
+            isEqual = bytesRead1 == 0;
+            break;
+        }
+        for (int i = 0; i < bytesRead1 && isEqual; ++i) {
+            isEqual = buffer1[i] == buffer2[i];
+        }
+    }
+    if (file1 >= 0) {
+        closeFile(file1);
+    }
+    if (file2 >= 0) {
+        closeFile(file2);
+    }
+    return isEqual;
+}
+
+/**
+ * the function hashes the content of a file (64 bit FNV-1a).
+ * @param filePath - the file we would like to hash.
+ * @param hash - the location we would like to save the hash to.
+ * @return - 1 if the file was hashed, else 0.
+ */
+int hashFile(const char *filePath, unsigned long long *hash) {
+    unsigned char buffer[HASH_BUFFER_SIZE];
+    int bytesRead;
+    int file = open(filePath, O_RDONLY);
+    if (file < 0) {
+        return 0;
+    }
+    *hash = FNV_OFFSET_BASIS;
+    while ((bytesRead = read(file, buffer, HASH_BUFFER_SIZE)) > 0) {
+        for (int i = 0; i < bytesRead; ++i) {
+            *hash ^= buffer[i];
+            *hash *= FNV_PRIME;
+        }
+    }
+    closeFile(file);
+    return bytesRead == 0;
+}
+
+/**
+ * executing the compiled c file and sending the wanted stdin.
+ * runs in the zygote's child, after the isolation was set up.
+ * @param binary - the compiled c file we want to execute, opened before the run's /tmp was mounted.
+ * @param binaryPath - the path the binary was opened from, passed as argv[0].
+ * @param argument - a command line argument for the program, NULL for none.
+ * @param inputFD - the file holding the input we want to run.
+ * @param outputFD - the file the output of the program is written to.
+ * @return - only returns if the execution failed.
+ */
+int executeCFile(int binary, char *binaryPath, char *argument, int inputFD, int outputFD) {
+    int retCode;
+    char *args[] = {binaryPath, argument, NULL};
+
+    retCode = dup2(inputFD, STDIN_FILENO);
+    if(retCode == SYSTEM_FAIL){
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+
+    retCode = dup2(outputFD, STDOUT_FILENO);
+    if(retCode == SYSTEM_FAIL){
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+
+    closeFile(inputFD);
+    closeFile(outputFD);
+
+    retCode = fexecve(binary, args, environ);
+    if(retCode == SYSTEM_FAIL){
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+    return retCode;
+}
+
+/**
+ * the function starts the zygote process & waits for it to report that it is ready.
+ * @param pSandbox - the sandbox we would like to start.
+ */
+void startSandbox(sandbox *pSandbox) {
+    int sockets[2];
+    //a seqpacket socket keeps every request & result in a message of its own.
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) == SYSTEM_FAIL) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+
+    pid_t pid = fork();
+    if (pid == SYSTEM_FAIL) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+    if (pid == 0) {
+        closeFile(sockets[0]);
+        runZygote(sockets[1]);
+    }
+
+    closeFile(sockets[1]);
+    pSandbox->pid = pid;
+    pSandbox->controlSocket = sockets[0];
+    if (recv(pSandbox->controlSocket, &pSandbox->isIsolated, sizeof(int), 0) != sizeof(int)) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+    if (pSandbox->isIsolated == 0) {
+        fprintf(stderr, "%s", "Sandbox isolation unavailable, running submissions without it.\n");
+    }
+}
+
+/**
+ * the function stops the zygote, closing the control socket tells it to exit.
+ * @param pSandbox - the sandbox we would like to stop.
+ */
+void stopSandbox(sandbox *pSandbox) {
+    closeFile(pSandbox->controlSocket);
+    waitpid(pSandbox->pid, NULL, 0);
+}
+
+/**
+ * the function asks the zygote to run a binary, passing it the stdin & stdout of the run.
+ * @param pSandbox - the zygote.
+ * @param runId - the id the result of the run will be reported with.
+ * @param binaryPath - the compiled c file we want to execute.
+ * @param argument - a command line argument for the program, NULL for none.
+ * @param inputFD - the file holding the input we want to run.
+ * @param outputFD - the file the output of the program is written to.
+ * @param timeLimit - the amount of seconds the run is allowed.
+ */
+void sandboxSubmit(sandbox *pSandbox, int runId, char *binaryPath, char *argument,
+                   int inputFD, int outputFD, int timeLimit) {
+    sandboxRequest request;
+    request.runId = runId;
+    request.timeLimit = timeLimit;
+    strCopy(request.binaryPath, binaryPath);
+    strCopy(request.argument, argument != NULL ? argument : "");
+
+    struct iovec data = {&request, sizeof(request)};
+    char control[CMSG_SPACE(SANDBOX_FDS_COUNT * sizeof(int))] = {0};
+    struct msghdr message = {0};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(SANDBOX_FDS_COUNT * sizeof(int));
+    int *fds = (int *)CMSG_DATA(header);
+    fds[0] = inputFD;
+    fds[1] = outputFD;
+
+    if (sendmsg(pSandbox->controlSocket, &message, 0) == SYSTEM_FAIL) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+}
+
+/**
+ * the function waits for the zygote to report the result of a run.
+ * @param pSandbox - the zygote.
+ * @param result - the location we would like to save the result to.
+ */
+void sandboxCollect(sandbox *pSandbox, sandboxResult *result) {
+    if (recv(pSandbox->controlSocket, result, sizeof(sandboxResult), 0) != sizeof(sandboxResult)) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+}
+
+/**
+ * the zygote process, sets the isolation up once & serves runs until the grader is done.
+ * a new pid namespace only applies to the children of the caller,
+ * so the runs are served by its first child which becomes the init of the namespace.
+ * if any part of the isolation fails, the runs are still served, reported as not isolated.
+ * @param controlSocket - the socket the requests are read from.
+ */
+void runZygote(int controlSocket) {
+    //the ids only map to the grader's user before the unshare.
+    uid_t uid = getuid();
+    gid_t gid = getgid();
+
+    //moving the zygote to new user, pid, mount & network namespaces.
+    if (unshare(CLONE_NEWUSER | CLONE_NEWPID | CLONE_NEWNS | CLONE_NEWNET) == SYSTEM_FAIL) {
+        serveSandboxRuns(controlSocket, 0);
+    }
+    int isIsolated = mapZygoteUser(uid, gid);
+
+    pid_t pid = fork();
+    if (pid == SYSTEM_FAIL) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+    if (pid == 0) {
+        if (isIsolated == 1 && mountSandboxFilesystem() == 0) {
+            isIsolated = 0;
+        }
+        serveSandboxRuns(controlSocket, isIsolated);
+    }
+    closeFile(controlSocket);
+    waitpid(pid, NULL, 0);
+    exit(0);
+}
+
+/**
+ * the function maps the grader's user to itself inside the zygote's new user namespace.
+ * @param uid - the user id of the grader.
+ * @param gid - the group id of the grader.
+ * @return - 1 if the user was mapped, else 0.
+ */
+int mapZygoteUser(uid_t uid, gid_t gid) {
+    char map[STRING_MAX_LENGTH];
+    char id[STRING_MAX_LENGTH];
+
+    strCopy(map, itoa(uid, id));
+    strConcatenate(map, " ");
+    strConcatenate(map, id);
+    strConcatenate(map, " 1");
+    if (writeProcFile("/proc/self/uid_map", map) == 0
+        || writeProcFile("/proc/self/setgroups", "deny") == 0) {
+        return 0;
+    }
+    strCopy(map, itoa(gid, id));
+    strConcatenate(map, " ");
+    strConcatenate(map, id);
+    strConcatenate(map, " 1");
+    return writeProcFile("/proc/self/gid_map", map);
+}
+
+/**
+ * the function sets the filesystem of the runs up:
+ * everything is read-only, except for a /proc of the new pid namespace.
+ * every run mounts a /tmp of its own on top of it (isolateRunTmp).
+ * /proc is mounted first, the mount most often refused in containers,
+ * so a failure there leaves the filesystem as writable as it was.
+ * @return - 1 if the filesystem was set up, else 0.
+ */
+int mountSandboxFilesystem() {
+    struct mount_attr readOnly = {0};
+    readOnly.attr_set = MOUNT_ATTR_RDONLY;
+
+    return mount(NULL, "/", NULL, MS_REC | MS_PRIVATE, NULL) != SYSTEM_FAIL
+           && mount("proc", "/proc", "proc", MS_NOSUID | MS_NODEV | MS_NOEXEC, NULL) != SYSTEM_FAIL
+           && mount_setattr(AT_FDCWD, "/", AT_RECURSIVE, &readOnly, sizeof(readOnly)) != SYSTEM_FAIL;
+}
+
+/**
+ * the function gives a run a fresh /tmp, in a mount namespace of its own.
+ * the tmpfs goes away with the namespace once the run exits,
+ * so nothing a run leaves in /tmp reaches the next ones.
+ */
+void isolateRunTmp() {
+    if (unshare(CLONE_NEWNS) == SYSTEM_FAIL
+        || mount("tmpfs", "/tmp", "tmpfs", MS_NOSUID | MS_NODEV, NULL) == SYSTEM_FAIL) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+}
+
+/**
+ * the function serves the run requests of the grader.
+ * every request forks a child executing the binary, the result is sent back
+ * once the child exits or is killed for running out of time.
+ * @param controlSocket - the socket the requests are read from.
+ * @param isIsolated - 1 if the runs are isolated, sent to the grader once ready.
+ */
+void serveSandboxRuns(int controlSocket, int isIsolated) {
+    sandboxRun runs[SANDBOX_MAX_RUNS];
+    int runsCount = 0;
+    int isOpen = 1;
+
+    if (send(controlSocket, &isIsolated, sizeof(int), 0) != sizeof(int)) {
+        exit(SYSTEM_FAIL);
+    }
+
+    while (isOpen == 1 || runsCount > 0) {
+        struct pollfd request = {controlSocket, POLLIN, 0};
+        if (isOpen == 1 && runsCount < SANDBOX_MAX_RUNS
+            && poll(&request, 1, SANDBOX_POLL_INTERVAL_MS) > 0) {
+            sandboxRequest runRequest;
+            char control[CMSG_SPACE(SANDBOX_FDS_COUNT * sizeof(int))];
+            struct iovec data = {&runRequest, sizeof(runRequest)};
+            struct msghdr message = {0};
+            message.msg_iov = &data;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof(control);
+
+            //the grader closed the socket, killing whatever is left & exiting.
+            if (recvmsg(controlSocket, &message, 0) <= 0) {
+                isOpen = 0;
+                for (int i = 0; i < runsCount; ++i) {
+                    kill(-runs[i].pid, SIGKILL);
                 }
+                continue;
             }
-            //if temp.out still running
-            if (returnPid == 0) {
-                int a = unlink(pStudents[i].compiledFileName);
-                int b = unlink(array);
-                gradeStudent(pStudents,i, "0", "TIMEOUT");
+            struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+            if (header == NULL || header->cmsg_type != SCM_RIGHTS) {
+                exit(SYSTEM_FAIL);
+            }
+            int *fds = (int *)CMSG_DATA(header);
+
+            pid_t pid = fork();
+            if (pid == 0) {
+                closeFile(controlSocket);
+                //a group of its own, so the children of the run are killed along with it.
+                setpgid(0, 0);
+                //bounding the files a run writes, its output included.
+                struct rlimit fileSize = {SANDBOX_MAX_FILE_SIZE, SANDBOX_MAX_FILE_SIZE};
+                setrlimit(RLIMIT_FSIZE, &fileSize);
+                //the binary is opened before /tmp is replaced, so paths under the host's /tmp still run.
+                int binary = open(runRequest.binaryPath, O_RDONLY);
+                if (binary < 0) {
+                    printError();
+                    exit(SYSTEM_FAIL);
+                }
+                if (isIsolated == 1) {
+                    isolateRunTmp();
+                }
+                executeCFile(binary, runRequest.binaryPath,
+                             runRequest.argument[0] != '\0' ? runRequest.argument : NULL, fds[0], fds[1]);
+            }
+            closeFile(fds[0]);
+            closeFile(fds[1]);
+            //out of processes (e.g. a fork bomb of a previous run), reporting a failed run right away.
+            if (pid == SYSTEM_FAIL) {
+                sandboxResult result = {0};
+                result.runId = runRequest.runId;
+                result.isStartFailed = 1;
+                result.status = W_EXITCODE(EXIT_FAILURE, 0);
+                send(controlSocket, &result, sizeof(result), 0);
                 continue;
+            }
+            setpgid(pid, pid);
+
+            runs[runsCount].pid = pid;
+            runs[runsCount].runId = runRequest.runId;
+            runs[runsCount].timedOut = 0;
+            runs[runsCount].startMs = currentTimeMs();
+            runs[runsCount].deadlineMs = runs[runsCount].startMs
+                                         + (long)runRequest.timeLimit * MILLISECONDS_IN_SECOND;
+            runsCount++;
+        } else if (isOpen == 0 || runsCount == SANDBOX_MAX_RUNS) {
+            struct timespec interval = {0, SANDBOX_POLL_INTERVAL_MS * 1000000L};
+            nanosleep(&interval, NULL);
+        }
+
+        //reaping the finished runs, anything else is an orphan left by a run.
+        int status;
+        struct rusage usage;
+        pid_t pid;
+        while ((pid = wait4(-1, &status, WNOHANG, &usage)) > 0) {
+            for (int i = 0; i < runsCount; ++i) {
+                if (runs[i].pid != pid) {
+                    continue;
+                }
+                sandboxResult result;
+                result.runId = runs[i].runId;
+                result.isStartFailed = 0;
+                result.timedOut = runs[i].timedOut;
+                result.status = status;
+                result.elapsedMs = currentTimeMs() - runs[i].startMs;
+                result.usage = usage;
+                if (isOpen == 1) {
+                    send(controlSocket, &result, sizeof(result), 0);
+                }
+                runs[i] = runs[runsCount - 1];
+                runsCount--;
+                break;
+            }
+        }
+
+        //killing the runs that are out of time.
+        long now = currentTimeMs();
+        for (int i = 0; i < runsCount; ++i) {
+            if (runs[i].timedOut == 0 && now >= runs[i].deadlineMs) {
+                runs[i].timedOut = 1;
+                kill(-runs[i].pid, SIGKILL);
+            }
+        }
+    }
+    exit(0);
+}
+
+/**
+ * the function writes a string to a file under /proc.
+ * @param filePath - the file we would like to write to.
+ * @param content - the string we would like to write.
+ * @return - 1 if the string was written, else 0.
+ */
+int writeProcFile(const char *filePath, const char *content) {
+    int file = open(filePath, O_WRONLY);
+    if (file < 0) {
+        return 0;
+    }
+    int isWritten = write(file, content, strLength(content)) != SYSTEM_FAIL;
+    closeFile(file);
+    return isWritten;
+}
+
+/**
+ * the function returns the time of a monotonic clock.
+ * @return - the time in milliseconds.
+ */
+long currentTimeMs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * MILLISECONDS_IN_SECOND + now.tv_nsec / 1000000L;
+}
+
+/**
+ * the function compares between the wanted result and the result that we got
+ * using comp.out.
+ * @param pStudents - the array of studentInfo.
+ * @param outputFilePath
+ * @param i - the number of the student we are currently working on.
+ * @param retCode - the return code from the execvp call.
+ * @param value - the value that got returned from the execution of comp.out
+ * @return
+ */
+int compareOutputs(studentInfo *pStudents, const char *outputFilePath, int i,
+                   int retCode, int *value,char *outputFileName) {
+    //preparing an array for the command.
+    const char *args[] = {
+            "/home/virgoa/Desktop/ex3_os/tal_proj/comp.out",
+            outputFileName,
+            outputFilePath,
+            NULL
+    };
+
+    char **array = (char **)malloc(ARRAY_OF_COMMANDS*sizeof(char *));
+    for (int i=0;i<ARRAY_OF_COMMANDS-2;i++)
+    {
+        array[i]=(char*)malloc(STRING_MAX_LENGTH*sizeof(char));
+    }
+    strCopy(array[0],"/home/virgoa/Desktop/ex3_os/tal_proj/comp.out");
+    strCopy(array[1],outputFileName);
+    strCopy(array[2],outputFilePath);
+    array[3] = NULL;
+
+
+    pid_t pid = 0;
+    pid = fork();
+    //executing the program in the child process.
+    if (pid == 0) {
+        retCode = execvp(args[0], array);
+        if(retCode == SYSTEM_FAIL){
+            printError();
+            exit(SYSTEM_FAIL);
+        }
+    }else{
+        for (int i=0;i<ARRAY_OF_COMMANDS-2;i++)
+        {
+            free(array[i]);
+        }
+        free(array);
+
+        waitpid(pid, value, 0);
+        if ( WIFEXITED((*value)) ) {
+            const int es = WEXITSTATUS((*value));
+            if (es == 1){
+                gradeStudent(pStudents,i,"60","BAD_OUTPUT");
+            }
+            if (es == 2){
+                gradeStudent(pStudents,i,"80","SIMILAR_OUTPUT");
+            }
+            if(es == 3){
+                gradeStudent(pStudents,i,"100","GREAT_JOB");
+            }
+            //a non identical output is kept for the diff report.
+            if (es == 1 || es == 2) {
+                strCopy(pStudents[i].outputFileName, outputFileName);
+                return (*value);
+            }
+        }
+        if( unlink(outputFileName) == SYSTEM_FAIL){
+            printError();
+            exit(SYSTEM_FAIL);
+        }
+    }
+    return (*value);
+}
+
+/**
+ * the function writes a report for every non identical output, holding
+ * the first divergence & a bounded unified diff against the expected output.
+ * only the first DIFF_MAX_INPUT_SIZE bytes of every output are read.
+ * a report that can't be written is skipped, the grades are written regardless.
+ * the reports of previous runs are deleted first, so every report left belongs to this run.
+ * the outputs kept for the reports are deleted afterwards.
+ * @param pStudents - the array of studentInfo.
+ * @param submissionsCount - the amount of submissions.
+ * @param outputFilePath - path to the correct output we are expecting.
+ */
+void writeDiffReports(studentInfo *pStudents, int submissionsCount, char *outputFilePath) {
+    long expectedSize;
+    int isExpectedTruncated;
+    char *expected = NULL;
+    int isReady = 0;
+
+    clearReportsFolder();
+    for (int i = 0; i < submissionsCount; ++i) {
+        if (pStudents[i].outputFileName[0] == '\0') {
+            continue;
+        }
+        if (isReady == 0) {
+            expected = readFileHead(outputFilePath, DIFF_MAX_INPUT_SIZE, &expectedSize, &isExpectedTruncated);
+            if (expected == NULL || (mkdir(REPORTS_FOLDER, 0755) == SYSTEM_FAIL && errno != EEXIST)) {
+                printError();
+                break;
+            }
+            isReady = 1;
+        }
+        writeDiffReport(pStudents, i, expected, expectedSize, isExpectedTruncated);
+    }
+
+    //deduplicated students share the output of the student they were matched with.
+    for (int i = 0; i < submissionsCount; ++i) {
+        if (pStudents[i].outputFileName[0] != '\0' && pStudents[i].isDeduplicated == 0) {
+            unlink(pStudents[i].outputFileName);
+        }
+    }
+    //removing the folder if no report was written, fails harmlessly otherwise.
+    rmdir(REPORTS_FOLDER);
+    free(expected);
+}
+
+/**
+ * the function deletes the reports left in the reports folder by previous runs.
+ */
+void clearReportsFolder() {
+    DIR *pDir;
+    struct dirent *pDirent;
+    if ((pDir = opendir(REPORTS_FOLDER)) == NULL) {
+        return;
+    }
+    while ((pDirent = readdir(pDir)) != NULL) {
+        if (pDirent->d_type == DT_REG && string_ends_with(pDirent->d_name, ".txt")) {
+            char reportPath[STRING_MAX_LENGTH];
+            strCopy(reportPath, REPORTS_FOLDER);
+            strConcatenate(reportPath, "/");
+            strConcatenate(reportPath, pDirent->d_name);
+            unlink(reportPath);
+        }
+    }
+    closedir(pDir);
+}
+
+/**
+ * the function writes the report of a single student to the reports folder.
+ * the report is skipped if anything it needs can't be allocated or written.
+ * @param pStudents - the array of studentInfo.
+ * @param i - the students number in the array.
+ * @param expected - the correct output, up to DIFF_MAX_INPUT_SIZE bytes.
+ * @param expectedSize - the size of the correct output that was read.
+ * @param isExpectedTruncated - 1 if the correct output is longer than what was read.
+ */
+void writeDiffReport(studentInfo *pStudents, int i, char *expected, long expectedSize, int isExpectedTruncated) {
+    long actualSize;
+    int isActualTruncated;
+    char *actual = readFileHead(pStudents[i].outputFileName, DIFF_MAX_INPUT_SIZE, &actualSize, &isActualTruncated);
+    if (actual == NULL) {
+        printError();
+        return;
+    }
+
+    diffLine *expectedLines = NULL;
+    diffLine *actualLines = NULL;
+    int expectedCount = splitLines(expected, expectedSize, &expectedLines);
+    int actualCount = splitLines(actual, actualSize, &actualLines);
+    char *ops = (char *)malloc(expectedCount + actualCount + 1);
+    int *trace = (int *)malloc((DIFF_MAX_EDITS + 1) * (DIFF_MAX_EDITS + 1) * sizeof(int));
+
+    char reportPath[STRING_MAX_LENGTH];
+    strCopy(reportPath, REPORTS_FOLDER);
+    strConcatenate(reportPath, "/");
+    strConcatenate(reportPath, pStudents[i].name);
+    strConcatenate(reportPath, ".txt");
+    int report = SYSTEM_FAIL;
+    if (expectedCount != SYSTEM_FAIL && actualCount != SYSTEM_FAIL && ops != NULL && trace != NULL) {
+        report = open(reportPath, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    }
+    if (report < 0) {
+        printError();
+    } else {
+        dprintf(report, "%s: %s\n", pStudents[i].name, pStudents[i].info);
+        if (isExpectedTruncated == 1 || isActualTruncated == 1) {
+            dprintf(report, "the %s output is longer than %ld bytes, only its beginning is compared.\n",
+                    isActualTruncated == 1 ? "student's" : "expected", DIFF_MAX_INPUT_SIZE);
+        }
+        writeFirstDivergence(report, expected, expectedSize, actual, actualSize);
+
+        int opsCount = diffLines(expectedLines, expectedCount, actualLines, actualCount, ops, trace);
+        if (opsCount == SYSTEM_FAIL) {
+            dprintf(report, "\nthe outputs differ in more than %d lines, diff omitted.\n", DIFF_MAX_EDITS);
+        } else {
+            dprintf(report, "\n--- expected\n+++ %s\n", pStudents[i].name);
+            writeUnifiedDiff(report, ops, opsCount, expectedLines, actualLines);
+        }
+        closeFile(report);
+    }
+
+    free(trace);
+    free(ops);
+    free(expectedLines);
+    free(actualLines);
+    free(actual);
+}
+
+/**
+ * the function writes where the output first diverged from the expected one.
+ * @param report - the report file.
+ * @param expected - the correct output.
+ * @param expectedSize - the size of the correct output.
+ * @param actual - the output of the student.
+ * @param actualSize - the size of the output of the student.
+ */
+void writeFirstDivergence(int report, char *expected, long expectedSize, char *actual, long actualSize) {
+    long offset = 0;
+    long lineStart = 0;
+    int line = 1;
+    while (offset < expectedSize && offset < actualSize && expected[offset] == actual[offset]) {
+        if (expected[offset] == '\n') {
+            line++;
+            lineStart = offset + 1;
+        }
+        offset++;
+    }
+
+    //printing the diverging line of both outputs, up to the end of the line.
+    int expectedLength = 0;
+    while (lineStart + expectedLength < expectedSize && expected[lineStart + expectedLength] != '\n'
+           && expectedLength < DIFF_PREVIEW_LENGTH) {
+        expectedLength++;
+    }
+    int actualLength = 0;
+    while (lineStart + actualLength < actualSize && actual[lineStart + actualLength] != '\n'
+           && actualLength < DIFF_PREVIEW_LENGTH) {
+        actualLength++;
+    }
+    dprintf(report, "first divergence: line %d, column %ld (byte %ld)\n",
+            line, offset - lineStart + 1, offset);
+    dprintf(report, "expected: %.*s%s\n", expectedLength, expected + lineStart,
+            offset >= expectedSize ? "<end of output>" : "");
+    dprintf(report, "actual:   %.*s%s\n", actualLength, actual + lineStart,
+            offset >= actualSize ? "<end of output>" : "");
+}
+
+/**
+ * the function splits a text to lines.
+ * @param text - the text we would like to split.
+ * @param size - the size of the text.
+ * @param lines - the location we would like to save the allocated array of lines to.
+ * @return - the amount of lines, SYSTEM_FAIL if the array couldn't be allocated.
+ */
+int splitLines(char *text, long size, diffLine **lines) {
+    int count = 0;
+    for (long i = 0; i < size; ++i) {
+        if (text[i] == '\n' || i == size - 1) {
+            count++;
+        }
+    }
+    *lines = (diffLine *)malloc((count + 1) * sizeof(diffLine));
+    if (*lines == NULL) {
+        return SYSTEM_FAIL;
+    }
+
+    int k = 0;
+    long start = 0;
+    for (long i = 0; i < size; ++i) {
+        if (text[i] == '\n' || i == size - 1) {
+            long end = text[i] == '\n' ? i : i + 1;
+            (*lines)[k].text = text + start;
+            (*lines)[k].length = (int)(end - start);
+            (*lines)[k].hasNewline = text[i] == '\n';
+            (*lines)[k].hash = FNV_OFFSET_BASIS;
+            for (long j = start; j < end; ++j) {
+                (*lines)[k].hash ^= (unsigned char)text[j];
+                (*lines)[k].hash *= FNV_PRIME;
+            }
+            k++;
+            start = i + 1;
+        }
+    }
+    return count;
+}
+
+/**
+ * the function compares between two lines.
+ * like diff, a last line missing its newline differs from the same line with it.
+ * @param line1
+ * @param line2
+ * @return - 1 if the lines are equal, else 0.
+ */
+int linesEqual(diffLine *line1, diffLine *line2) {
+    if (line1->hash != line2->hash || line1->length != line2->length
+        || line1->hasNewline != line2->hasNewline) {
+        return 0;
+    }
+    for (int i = 0; i < line1->length; ++i) {
+        if (line1->text[i] != line2->text[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * the function finds the shortest edit script between two outputs (Myers' O(ND) algorithm).
+ * the common prefix & suffix are skipped, and the search gives up after DIFF_MAX_EDITS edits,
+ * so the furthest reaching paths it keeps take O(DIFF_MAX_EDITS^2) whatever the size of the outputs.
+ * @param expected - the lines of the correct output.
+ * @param expectedCount - the amount of lines in the correct output.
+ * @param actual - the lines of the student's output.
+ * @param actualCount - the amount of lines in the student's output.
+ * @param ops - the location we would like to save the script to, one of
+ * DIFF_EQUAL, DIFF_DELETE & DIFF_INSERT per line.
+ * @param trace - room for (DIFF_MAX_EDITS + 1)^2 furthest reaching paths.
+ * @return - the length of the script, SYSTEM_FAIL if there are more than DIFF_MAX_EDITS edits.
+ */
+int diffLines(diffLine *expected, int expectedCount, diffLine *actual, int actualCount, char *ops, int *trace) {
+    int prefix = 0;
+    while (prefix < expectedCount && prefix < actualCount
+           && linesEqual(&expected[prefix], &actual[prefix])) {
+        prefix++;
+    }
+    int suffix = 0;
+    while (suffix < expectedCount - prefix && suffix < actualCount - prefix
+           && linesEqual(&expected[expectedCount - 1 - suffix], &actual[actualCount - 1 - suffix])) {
+        suffix++;
+    }
+    diffLine *a = expected + prefix;
+    diffLine *b = actual + prefix;
+    int n = expectedCount - prefix - suffix;
+    int m = actualCount - prefix - suffix;
+
+    //trace holds the furthest x of every diagonal k in [-d, d] for every d, at trace[d * d + k + d].
+    int edits = SYSTEM_FAIL;
+    for (int d = 0; d <= DIFF_MAX_EDITS && edits == SYSTEM_FAIL; ++d) {
+        int *current = trace + d * d + d;
+        int *previous = trace + (d - 1) * (d - 1) + (d - 1);
+        for (int k = -d; k <= d; k += 2) {
+            int x;
+            if (d == 0) {
+                x = 0;
+            } else if (k == -d || (k != d && previous[k - 1] < previous[k + 1])) {
+                x = previous[k + 1];
             } else {
-                status = compareOutputs(pStudents, outputFilePath, i, retCode, &status,array);
+                x = previous[k - 1] + 1;
+            }
+            int y = x - k;
+            while (x < n && y < m && linesEqual(&a[x], &b[y])) {
+                x++;
+                y++;
+            }
+            current[k] = x;
+            if (x >= n && y >= m) {
+                edits = d;
+                break;
+            }
+        }
+    }
+    if (edits == SYSTEM_FAIL) {
+        return SYSTEM_FAIL;
+    }
+
+    //walking the trace back from the end, the script is written backwards.
+    int opsCount = prefix + (n + m + edits) / 2 + suffix;
+    int k = opsCount;
+    int x = n;
+    int y = m;
+    for (int j = 0; j < suffix; ++j) {
+        ops[--k] = DIFF_EQUAL;
+    }
+    for (int d = edits; d > 0; --d) {
+        int *previous = trace + (d - 1) * (d - 1) + (d - 1);
+        int diagonal = x - y;
+        int previousDiagonal;
+        if (diagonal == -d || (diagonal != d && previous[diagonal - 1] < previous[diagonal + 1])) {
+            previousDiagonal = diagonal + 1;
+        } else {
+            previousDiagonal = diagonal - 1;
+        }
+        int previousX = previous[previousDiagonal];
+        int previousY = previousX - previousDiagonal;
+        while (x > previousX && y > previousY) {
+            ops[--k] = DIFF_EQUAL;
+            x--;
+            y--;
+        }
+        if (previousDiagonal == diagonal + 1) {
+            ops[--k] = DIFF_INSERT;
+        } else {
+            ops[--k] = DIFF_DELETE;
+        }
+        x = previousX;
+        y = previousY;
+    }
+    while (k > 0) {
+        ops[--k] = DIFF_EQUAL;
+    }
+    return opsCount;
+}
+
+/**
+ * the function writes an edit script as unified diff hunks,
+ * up to DIFF_MAX_LINES lines.
+ * @param report - the report file.
+ * @param ops - the edit script.
+ * @param opsCount - the length of the script.
+ * @param expected - the lines of the correct output.
+ * @param actual - the lines of the student's output.
+ */
+void writeUnifiedDiff(int report, char *ops, int opsCount, diffLine *expected, diffLine *actual) {
+    int written = 0;
+    int expectedLine = 0;
+    int actualLine = 0;
+    int i = 0;
+    while (i < opsCount) {
+        if (ops[i] == DIFF_EQUAL) {
+            expectedLine++;
+            actualLine++;
+            i++;
+            continue;
+        }
+
+        //a hunk starts with some context, and takes every change up to a long enough equal run.
+        int context = 0;
+        while (context < DIFF_CONTEXT_LINES && context < i && ops[i - context - 1] == DIFF_EQUAL) {
+            context++;
+        }
+        int start = i - context;
+        int end = i;
+        while (end < opsCount) {
+            if (ops[end] != DIFF_EQUAL) {
+                end++;
+                continue;
+            }
+            int run = 0;
+            while (end + run < opsCount && ops[end + run] == DIFF_EQUAL) {
+                run++;
+            }
+            if (end + run == opsCount || run > 2 * DIFF_CONTEXT_LINES) {
+                end += run < DIFF_CONTEXT_LINES ? run : DIFF_CONTEXT_LINES;
+                break;
+            }
+            end += run;
+        }
+
+        int expectedStart = expectedLine - context;
+        int actualStart = actualLine - context;
+        int expectedLength = 0;
+        int actualLength = 0;
+        for (int j = start; j < end; ++j) {
+            expectedLength += ops[j] != DIFF_INSERT;
+            actualLength += ops[j] != DIFF_DELETE;
+        }
+        dprintf(report, "@@ ");
+        writeHunkRange(report, DIFF_DELETE, expectedStart, expectedLength);
+        dprintf(report, " ");
+        writeHunkRange(report, DIFF_INSERT, actualStart, actualLength);
+        dprintf(report, " @@\n");
+
+        expectedLine = expectedStart;
+        actualLine = actualStart;
+        for (int j = start; j < end; ++j) {
+            if (written == DIFF_MAX_LINES) {
+                dprintf(report, "... diff truncated after %d lines.\n", DIFF_MAX_LINES);
+                return;
+            }
+            diffLine *line = ops[j] == DIFF_INSERT ? &actual[actualLine] : &expected[expectedLine];
+            int length = line->length < DIFF_PREVIEW_LENGTH ? line->length : DIFF_PREVIEW_LENGTH;
+            dprintf(report, "%c%.*s%s\n", ops[j], length, line->text,
+                    line->length > DIFF_PREVIEW_LENGTH ? "..." : "");
+            if (line->hasNewline == 0) {
+                dprintf(report, "\\ No newline at end of file\n");
+            }
+            expectedLine += ops[j] != DIFF_INSERT;
+            actualLine += ops[j] != DIFF_DELETE;
+            written++;
+        }
+        i = end;
+    }
+}
+
+/**
+ * the function writes the range of a hunk the way diff -u does:
+ * an empty range starts at the line before it, and a single line range has no length.
+ * @param report - the report file.
+ * @param sign - DIFF_DELETE for the expected output, DIFF_INSERT for the student's.
+ * @param start - the index of the first line in the range.
+ * @param length - the amount of lines in the range.
+ */
+void writeHunkRange(int report, char sign, int start, int length) {
+    if (length == 1) {
+        dprintf(report, "%c%d", sign, start + 1);
+    } else {
+        dprintf(report, "%c%d,%d", sign, length == 0 ? start : start + 1, length);
+    }
+}
+
+/**
+ * the function processes a request to grade a student.
+ * @param pStudents - the array of studentInfo.
+ * @param i - the students number in the array.
+ * @param grade - the grade we want the student to have.
+ * @param info - the reasoning behind the grade.
+ */
+void gradeStudent(studentInfo *pStudents,int i, char *grade, char *info) {
+    pStudents[i].isGraded = 1;
+    strCopy(pStudents[i].grade, grade);
+    strCopy(pStudents[i].info,info);
+}
+
+/**
+ * the function compiles all the c files submitted by the students.
+ * the compilations are kept in flight up to the limit of the concurrency controller.
+ * @param submissionsCount - number of submissions.
+ * @param myStudents - a pointer to an array holding all the students data.
+ * @param pController - the controller deciding how many compilations are in flight.
+ */
+void compileAllCFiles(int submissionsCount, studentInfo *myStudents, concurrencyController *pController) {
+    unsigned int cohortHeaders = buildCohortHeader(submissionsCount, myStudents);
+    compileJob *jobs = (compileJob *)malloc(submissionsCount * sizeof(compileJob));
+    if (jobs == NULL && submissionsCount > 0) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
 
+    int next = 0;
+    int inFlight = 0;
+    while (next < submissionsCount || inFlight > 0) {
+        while (next < submissionsCount && inFlight < controllerLimit(pController)) {
+            int i = next++;
+            jobs[i].pid = 0;
+            if(myStudents[i].isGraded == 1){
+                continue;
             }
+            // the precompiled header only applies if the file includes every header in it.
+            jobs[i].usesCohortHeader = cohortHeaders != 0
+                                       && (myStudents[i].includedHeaders & cohortHeaders) == cohortHeaders;
+            jobs[i].pid = spawnCompilation(myStudents, i, jobs[i].usesCohortHeader);
+            jobs[i].startMs = currentTimeMs();
+            inFlight++;
+        }
+        if (inFlight == 0) {
+            continue;
         }
 
+        //waiting for any of the compilations to finish.
+        int status;
+        struct rusage usage;
+        pid_t pid = wait4(-1, &status, 0, &usage);
+        int i = 0;
+        while (i < next && (pid <= 0 || jobs[i].pid != pid)) {
+            i++;
+        }
+        if (i == next) {
+            continue;
+        }
+        jobs[i].pid = 0;
+        inFlight--;
+        controllerObserve(pController, currentTimeMs() - jobs[i].startMs, &usage, 0);
+
+        if(checkCompileSuccess(myStudents[i].compiledFileName,myStudents[i].compiledFileName) == 0){
+            // falling back to a normal compilation in case the injected header broke it.
+            if (jobs[i].usesCohortHeader) {
+                jobs[i].usesCohortHeader = 0;
+                jobs[i].pid = spawnCompilation(myStudents, i, 0);
+                jobs[i].startMs = currentTimeMs();
+                inFlight++;
+            } else {
+                gradeStudent(myStudents,i,"0","COMPILATION_ERROR");
+            }
+        }
+    }
+    free(jobs);
 
+    if (cohortHeaders != 0) {
+        unlink(COHORT_HEADER);
+        unlink(COHORT_PRECOMPILED_HEADER);
+    }
+}
+
+/**
+ * the function starts the compilation of a c file without waiting for it.
+ * @param myStudents - a pointer to an array holding all the students data.
+ * @param i - the number of the student.
+ * @param usesCohortHeader - 1 if the precompiled header is injected to the compilation.
+ * @return - the pid of the compilation.
+ */
+pid_t spawnCompilation(studentInfo *myStudents, int i, int usesCohortHeader) {
+    char num[STRING_MAX_LENGTH];
+    char array[STRING_MAX_LENGTH];
+    // defining the arrayu we are going to pass to the execv
+    // stripping the symbols (-s) drops the source path, so identical sources
+    // produce identical binaries for the execution cache.
+    char *args[COMPILE_ARGS_LENGTH];
+    int j = 0;
+    args[j++] = "gcc";
+    args[j++] = "-s";
+    if (usesCohortHeader) {
+        args[j++] = "-include";
+        args[j++] = COHORT_HEADER;
     }
+    args[j++] ="-o";
+    itoa(i,num);
+    strCopy(array,"temp");
+    strConcatenate(array,num);
+    strConcatenate(array,".out");
+    strCopy(myStudents[i].compiledFileName,array);
+    args[j++]=array;
+    args[j++] = myStudents[i].cFilePath;
+    args[j] = NULL;
+    //compiling the file.
+    return spawnCommand(args);
 }
 
 /**
- * executing the compiled c file and sending the wanted stdin.
- * @param inputFilePath - the location of the file holding the input we want to run.
- * @param args - the command we want to execute.
- * @param retCode
- * @return
+ * the function precompiles the system headers included by most of the submissions,
+ * so gcc parses them once for the whole cohort instead of once per submission.
+ * @param submissionsCount - number of submissions.
+ * @param myStudents - a pointer to an array holding all the students data.
+ * @return - a mask of the headers in the precompiled header, 0 if there is none.
  */
-int executeCFile(char *inputFilePath, char **args, int retCode,int i,char *outputFileName) {
-    int programOutputFD;
-    int programInputFD;
+unsigned int buildCohortHeader(int submissionsCount, studentInfo *myStudents) {
+    cohortHeader headers[COHORT_MAX_HEADERS];
+    int headersCount = 0;
+    int compiledCount = 0;
+    unsigned int cohortHeaders = 0;
 
-    programOutputFD = open(outputFileName, O_CREAT | O_TRUNC | O_WRONLY, 0644);
-    programInputFD = open(inputFilePath, O_RDONLY);
-
-    if (programInputFD < 0 || programOutputFD < 0) {
-        printError();
-        exit(SYSTEM_FAIL);
+    for (int i = 0; i < submissionsCount; ++i) {
+        myStudents[i].includedHeaders = 0;
+        if (myStudents[i].isGraded != 1) {
+            myStudents[i].includedHeaders = scanIncludedHeaders(myStudents[i].cFilePath, headers, &headersCount);
+            compiledCount++;
+        }
     }
 
-    retCode = dup2(programInputFD, STDIN_FILENO);
-    if(retCode == SYSTEM_FAIL){
+    //writing the headers included by the majority of the cohort.
+    int file = open(COHORT_HEADER, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if (file < 0) {
         printError();
         exit(SYSTEM_FAIL);
     }
-
-    retCode = dup2(programOutputFD, STDOUT_FILENO);
-    if(retCode == SYSTEM_FAIL){
-        printError();
-        exit(SYSTEM_FAIL);
+    for (int i = 0; i < headersCount; ++i) {
+        if (headers[i].count > 1 && headers[i].count * 2 > compiledCount) {
+            char line[STRING_MAX_LENGTH];
+            strCopy(line, "#include <");
+            strConcatenate(line, headers[i].name);
+            strConcatenate(line, ">\n");
+            if (write(file, line, strLength(line)) == SYSTEM_FAIL) {
+                printError();
+                closeFile(file);
+                exit(SYSTEM_FAIL);
+            }
+            cohortHeaders |= 1u << i;
+        }
     }
+    closeFile(file);
 
-    retCode = execvp(args[0], &args[0]);
-    if(retCode == SYSTEM_FAIL){
-        printError();
-        exit(SYSTEM_FAIL);
+    if (cohortHeaders != 0) {
+        char *args[] = {"gcc", "-x", "c-header", COHORT_HEADER, "-o", COHORT_PRECOMPILED_HEADER, NULL};
+        executeCommand(args);
+        if (checkCompileSuccess(COHORT_PRECOMPILED_HEADER, COHORT_PRECOMPILED_HEADER) == 0) {
+            cohortHeaders = 0;
+        }
     }
-
-    closeFile(programInputFD);
-    closeFile(programOutputFD);
-    return retCode;
+    if (cohortHeaders == 0) {
+        unlink(COHORT_HEADER);
+    }
+    return cohortHeaders;
 }
 
 /**
- * the function compares between the wanted result and the result that we got
- * using comp.out.
- * @param pStudents - the array of studentInfo.
- * @param outputFilePath
- * @param i - the number of the student we are currently working on.
- * @param retCode - the return code from the execvp call.
- * @param value - the value that got returned from the execution of comp.out
- * @return
+ * the function finds the system headers a c file includes & counts them in the cohort's headers.
+ * only the system includes preceding any other directive or local include are taken,
+ * since a macro defined before an include (e.g. _GNU_SOURCE) changes what the header declares.
+ * @param cFilePath - the c file we would like to scan.
+ * @param headers - the headers included by the cohort so far.
+ * @param headersCount - the amount of headers in the array.
+ * @return - a mask of the headers included by the c file.
  */
-int compareOutputs(studentInfo *pStudents, const char *outputFilePath, int i,
-                   int retCode, int *value,char *outputFileName) {
-    //preparing an array for the command.
-    const char *args[] = {
-            "/home/virgoa/Desktop/ex3_os/tal_proj/comp.out",
-            outputFileName,
-            outputFilePath,
-            NULL
-    };
-
-    char **array = (char **)malloc(ARRAY_OF_COMMANDS*sizeof(char *));
-    for (int i=0;i<ARRAY_OF_COMMANDS-2;i++)
-    {
-        array[i]=(char*)malloc(STRING_MAX_LENGTH*sizeof(char));
+unsigned int scanIncludedHeaders(char *cFilePath, cohortHeader *headers, int *headersCount) {
+    long size;
+    unsigned int included = 0;
+    char *source = readWholeFile(cFilePath, &size);
+    if (source == NULL) {
+        return 0;
     }
-    strCopy(array[0],"/home/virgoa/Desktop/ex3_os/tal_proj/comp.out");
-    strCopy(array[1],outputFileName);
-    strCopy(array[2],outputFilePath);
-    array[3] = NULL;
-
 
-    pid_t pid = 0;
-    pid = fork();
-    //executing the program in the child process.
-    if (pid == 0) {
-        retCode = execvp(args[0], array);
-        if(retCode == SYSTEM_FAIL){
-            printError();
-            exit(SYSTEM_FAIL);
-        }
-    }else{
-        for (int i=0;i<ARRAY_OF_COMMANDS-2;i++)
-        {
-            free(array[i]);
+    char *line = source;
+    while (*line != '\0') {
+        char *p = line;
+        while (*p == ' ' || *p == '\t') {
+            p++;
         }
-        free(array);
+        if (*p == '#') {
+            p++;
+            while (*p == ' ' || *p == '\t') {
+                p++;
+            }
+            char include[] = "include";
+            int k = 0;
+            while (include[k] != '\0' && p[k] == include[k]) {
+                k++;
+            }
+            if (include[k] != '\0') {
+                break;
+            }
+            p += k;
+            while (*p == ' ' || *p == '\t') {
+                p++;
+            }
+            //a local header may define macros too, so it ends the scan like any other directive.
+            if (*p != '<') {
+                break;
+            }
+            char name[STRING_MAX_LENGTH];
+            int length = 0;
+            p++;
+            while (*p != '>' && *p != '\n' && *p != '\0' && length < STRING_MAX_LENGTH - 1) {
+                name[length++] = *p++;
+            }
+            name[length] = '\0';
 
-        waitpid(pid, value, 0);
-        if ( WIFEXITED((*value)) ) {
-            const int es = WEXITSTATUS((*value));
-            if (es == 1){
-                gradeStudent(pStudents,i,"60","BAD_OUTPUT");
+            int j = 0;
+            while (j < *headersCount && strCompare(headers[j].name, name) != 0) {
+                j++;
             }
-            if (es == 2){
-                gradeStudent(pStudents,i,"80","SIMILAR_OUTPUT");
+            if (*p == '>' && j == *headersCount && *headersCount < COHORT_MAX_HEADERS) {
+                strCopy(headers[j].name, name);
+                headers[j].count = 0;
+                (*headersCount)++;
             }
-            if(es == 3){
-                gradeStudent(pStudents,i,"100","GREAT_JOB");
+            if (*p == '>' && j < *headersCount && (included & (1u << j)) == 0) {
+                headers[j].count++;
+                included |= 1u << j;
             }
         }
-        if( unlink(outputFileName) == SYSTEM_FAIL){
-            printError();
-            exit(SYSTEM_FAIL);
+        //moving on to the next line.
+        while (*line != '\n' && *line != '\0') {
+            line++;
+        }
+        if (*line == '\n') {
+            line++;
         }
     }
-    return (*value);
+    free(source);
+    return included;
 }
 
 /**
- * the function processes a request to grade a student.
- * @param pStudents - the array of studentInfo.
- * @param i - the students number in the array.
- * @param grade - the grade we want the student to have.
- * @param info - the reasoning behind the grade.
+ * the function reads a whole file to memory.
+ * @param filePath - the file we would like to read.
+ * @param size - the location we would like to save the size of the file to.
+ * @return - an allocated null terminated buffer, NULL if the file couldn't be read.
  */
-void gradeStudent(studentInfo *pStudents,int i, char *grade, char *info) {
-    pStudents[i].isGraded = 1;
-    strCopy(pStudents[i].grade, grade);
-    strCopy(pStudents[i].info,info);
+char *readWholeFile(const char *filePath, long *size) {
+    int file = open(filePath, O_RDONLY);
+    if (file < 0) {
+        return NULL;
+    }
+    *size = lseek(file, 0, SEEK_END);
+    if (*size < 0 || lseek(file, 0, SEEK_SET) < 0) {
+        closeFile(file);
+        return NULL;
+    }
+    char *buffer = (char *)malloc(*size + 1);
+    if (buffer == NULL) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+    long total = 0;
+    int bytesRead;
+    while (total < *size && (bytesRead = read(file, buffer + total, *size - total)) > 0) {
+        total += bytesRead;
+    }
+    closeFile(file);
+    *size = total;
+    buffer[total] = '\0';
+    return buffer;
 }
 
 /**
- * the function compiles all the c files submitted by the students.
- * @param submissionsCount - number of submissions.
- * @param myStudents - a pointer to an array holding all the students data.
+ * the function reads the beginning of a file to memory, up to the last full line that fits.
+ * unlike readWholeFile it never exits, a file it can't read is left to the caller.
+ * @param filePath - the file we would like to read.
+ * @param maxSize - the most bytes we would like to read.
+ * @param size - the location we would like to save the amount of bytes read to.
+ * @param isTruncated - the location we would like to save 1 to if the file is longer, else 0.
+ * @return - an allocated null terminated buffer, NULL if the file couldn't be read.
  */
-void compileAllCFiles(int submissionsCount, studentInfo *myStudents) {
-    for (int i = 0; i < submissionsCount ; ++i) {
-        char num[STRING_MAX_LENGTH];
-        char array[STRING_MAX_LENGTH];
-        if(myStudents[i].isGraded != 1){
-            // defining the arrayu we are going to pass to the execv
-            char *args[ARRAY_OF_COMMANDS];
-            args[0] = "gcc";
-            args[1] ="-o";
-            itoa(i,num);
-            strCopy(array,"temp");
-            strConcatenate(array,num);
-            strConcatenate(array,".out");
-            strCopy(myStudents[i].compiledFileName,array);
-            args[2]=array;
-            args[3] = myStudents[i].cFilePath;
-            args[4] = NULL;
-            //compiling the file.
-            executeCommand(args);
-
-            if(checkCompileSuccess(array,myStudents[i].compiledFileName) == 0){
-                gradeStudent(myStudents,i,"0","COMPILATION_ERROR");
-            }
+char *readFileHead(const char *filePath, long maxSize, long *size, int *isTruncated) {
+    int file = open(filePath, O_RDONLY);
+    if (file < 0) {
+        return NULL;
+    }
+    char *buffer = (char *)malloc(maxSize + 1);
+    if (buffer == NULL) {
+        closeFile(file);
+        return NULL;
+    }
+    long total = 0;
+    int bytesRead = 0;
+    while (total < maxSize && (bytesRead = read(file, buffer + total, maxSize - total)) > 0) {
+        total += bytesRead;
+    }
+    char next;
+    *isTruncated = total == maxSize && read(file, &next, 1) == 1;
+    closeFile(file);
+    if (bytesRead < 0) {
+        free(buffer);
+        return NULL;
+    }
 
+    //dropping the line that was cut in the middle.
+    if (*isTruncated == 1) {
+        long end = total;
+        while (end > 0 && buffer[end - 1] != '\n') {
+            end--;
         }
+        total = end > 0 ? end : total;
     }
+    *size = total;
+    buffer[total] = '\0';
+    return buffer;
 }
 
 /**
@@ -390,8 +1903,18 @@ int checkCompileSuccess(char *compiledFile,char *compiledFilePath) {
  * @param args - an array of strings containing the commands.
  */
 void executeCommand(char **args) {
+    pid_t pid = spawnCommand(args);
+    // wait for the child process to finish.
+    waitpid(pid, NULL, WCONTINUED);
+}
+
+/**
+ * the function starts the provided command without waiting for it.
+ * @param args - an array of strings containing the commands.
+ * @return - the pid of the child process executing the command.
+ */
+pid_t spawnCommand(char **args) {
 
-    int stat = 0;
     int retCode = 0;
     pid_t pid = 0;
     pid = fork();
@@ -402,11 +1925,164 @@ void executeCommand(char **args) {
             printError();
             exit(SYSTEM_FAIL);
         }
-    } else {
-        // if its the father process, wait for the child process to finish.
-        waitpid(pid, NULL, WCONTINUED);
+    } else if (pid == SYSTEM_FAIL) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+    return pid;
+}
+
+/**
+ * the function sets the concurrency controller up, starting at half of the cpus.
+ * @param pController - the controller.
+ */
+void initController(concurrencyController *pController) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    pController->cpus = cpus < 1 ? 1 : (int)cpus;
+    pController->maxLimit = pController->cpus < SANDBOX_MAX_RUNS ? pController->cpus : SANDBOX_MAX_RUNS;
+    pController->limit = pController->maxLimit / 2 > 1 ? pController->maxLimit / 2 : 1;
+    pController->stretch = 1.0;
+    pController->lastAdjustMs = currentTimeMs();
+    pController->lastBackoffMs = 0;
+}
+
+/**
+ * the function returns how many jobs may be in flight, adjusting it once in an interval.
+ * the limit is halved when the machine is under pressure, and grows by one when it is idle.
+ * @param pController - the controller.
+ * @return - the amount of jobs that may be in flight.
+ */
+int controllerLimit(concurrencyController *pController) {
+    long now = currentTimeMs();
+    if (now - pController->lastAdjustMs < CONTROLLER_INTERVAL_MS) {
+        return pController->limit;
+    }
+    pController->lastAdjustMs = now;
+
+    double cpuPressure = readPressure("/proc/pressure/cpu");
+    double memoryPressure = readPressure("/proc/pressure/memory");
+    double load = readLoadAverage() / pController->cpus;
+
+    if (cpuPressure > CONTROLLER_CPU_PRESSURE_HIGH || memoryPressure > CONTROLLER_MEMORY_PRESSURE_HIGH
+        || load > CONTROLLER_LOAD_HIGH || pController->stretch > CONTROLLER_STRETCH_HIGH) {
+        //the averages lag behind, giving the previous backoff time to show in them.
+        if (now - pController->lastBackoffMs >= CONTROLLER_BACKOFF_HOLD_MS) {
+            controllerBackoff(pController);
+        }
+    } else if (cpuPressure < CONTROLLER_CPU_PRESSURE_LOW && memoryPressure < CONTROLLER_MEMORY_PRESSURE_LOW
+               && load < CONTROLLER_LOAD_LOW && pController->stretch < CONTROLLER_STRETCH_LOW
+               && pController->limit < pController->maxLimit) {
+        pController->limit++;
+    }
+    return pController->limit;
+}
+
+/**
+ * the function reports a finished job to the controller.
+ * the stretch of a job is its wall time over its cpu time, growing when it waits for a cpu.
+ * @param pController - the controller.
+ * @param elapsedMs - the wall time of the job.
+ * @param usage - the resources used by the job.
+ * @param timeLimit - the seconds the job was allowed, 0 if it has no limit.
+ */
+void controllerObserve(concurrencyController *pController, long elapsedMs, struct rusage *usage, int timeLimit) {
+    long cpuMs = usageCpuMs(usage);
+    //short jobs are mostly startup, their stretch says nothing.
+    if (cpuMs < CONTROLLER_MIN_CPU_MS) {
+        return;
+    }
+    double stretch = (double)elapsedMs / cpuMs;
+    pController->stretch = pController->stretch * (1 - CONTROLLER_STRETCH_WEIGHT)
+                           + stretch * CONTROLLER_STRETCH_WEIGHT;
+
+    //a run past half of its time limit while waiting for a cpu is close to a false TIMEOUT.
+    //held like the periodic backoff, so the results of one stretched batch halve the limit only once.
+    if (timeLimit > 0 && elapsedMs * 2 > (long)timeLimit * MILLISECONDS_IN_SECOND
+        && stretch > CONTROLLER_STRETCH_HIGH
+        && currentTimeMs() - pController->lastBackoffMs >= CONTROLLER_BACKOFF_HOLD_MS) {
+        controllerBackoff(pController);
+    }
+}
+
+/**
+ * the function sums the user & system time of a job.
+ * @param usage - the resources used by the job.
+ * @return - the cpu time in milliseconds.
+ */
+long usageCpuMs(struct rusage *usage) {
+    return (usage->ru_utime.tv_sec + usage->ru_stime.tv_sec) * MILLISECONDS_IN_SECOND
+           + (usage->ru_utime.tv_usec + usage->ru_stime.tv_usec) / 1000;
+}
+
+/**
+ * the function checks if a job spent most of its time waiting for a cpu rather than running.
+ * @param elapsedMs - the wall time of the job.
+ * @param usage - the resources used by the job.
+ * @return - 1 if its stretch is above CONTROLLER_STRETCH_HIGH, else 0 (also for jobs too short to tell).
+ */
+int isRunStretched(long elapsedMs, struct rusage *usage) {
+    long cpuMs = usageCpuMs(usage);
+    return cpuMs >= CONTROLLER_MIN_CPU_MS && elapsedMs > cpuMs * CONTROLLER_STRETCH_HIGH;
+}
+
+/**
+ * the function halves the amount of jobs that may be in flight.
+ * @param pController - the controller.
+ */
+void controllerBackoff(concurrencyController *pController) {
+    pController->limit = pController->limit / 2 > 1 ? pController->limit / 2 : 1;
+    pController->lastBackoffMs = currentTimeMs();
+}
+
+/**
+ * the function reads the share of time tasks were stalled on a resource over the last 10 seconds.
+ * @param filePath - the pressure stall info file of the resource.
+ * @return - the "some avg10" percentage, 0 if the kernel doesn't provide it.
+ */
+double readPressure(const char *filePath) {
+    char buffer[PROC_FILE_LENGTH];
+    int file = open(filePath, O_RDONLY);
+    if (file < 0) {
+        return 0;
+    }
+    int bytesRead = read(file, buffer, PROC_FILE_LENGTH - 1);
+    closeFile(file);
+    if (bytesRead <= 0) {
+        return 0;
+    }
+    buffer[bytesRead] = '\0';
+
+    //the "some" line comes first, so the first avg10 is its own.
+    char key[] = "avg10=";
+    for (int i = 0; buffer[i] != '\0'; ++i) {
+        int k = 0;
+        while (key[k] != '\0' && buffer[i + k] == key[k]) {
+            k++;
+        }
+        if (key[k] == '\0') {
+            return strtod(buffer + i + k, NULL);
+        }
+    }
+    return 0;
+}
 
+/**
+ * the function reads the load average of the last minute.
+ * @return - the load average, 0 if it couldn't be read.
+ */
+double readLoadAverage() {
+    char buffer[PROC_FILE_LENGTH];
+    int file = open("/proc/loadavg", O_RDONLY);
+    if (file < 0) {
+        return 0;
     }
+    int bytesRead = read(file, buffer, PROC_FILE_LENGTH - 1);
+    closeFile(file);
+    if (bytesRead <= 0) {
+        return 0;
+    }
+    buffer[bytesRead] = '\0';
+    return strtod(buffer, NULL);
 }
 
 /**
@@ -448,6 +2124,11 @@ void assignFolderAndName(studentInfo *pStudents, char *folders) {
             strConcatenate(currentPath, "/");
             strConcatenate(currentPath, pDirent->d_name);
             strCopy(pStudents[i].dirPath,currentPath);
+            pStudents[i].isGraded = 0;
+            pStudents[i].isDeduplicated = 0;
+            pStudents[i].outputFileName[0] = '\0';
+            pStudents[i].failingSeed = SYSTEM_FAIL;
+            pStudents[i].differentialInfo[0] = '\0';
             i++;
         }
     }
@@ -486,9 +2167,14 @@ int countSubmittedFolders(char *folders) {
  * @param testInput - a pointer to a char array that will hold
  * the location of input we would like to run.
  * @param correctOutPut - a pointer to a char array that will hold the correct output.
+ * @param generator - a pointer to a char array that will hold the location of the
+ * generator of random inputs, empty if the config doesn't have one.
+ * @param reference - a pointer to a char array that will hold the location of the reference solution.
+ * @param seeds - a pointer to a char array that will hold the amount of seeds to test.
  */
 void readConfigFile(char *const *argv,  char *studentFolders,
-                     char *testInput,  char *correctOutPut) {
+                     char *testInput,  char *correctOutPut,
+                     char *generator, char *reference, char *seeds) {
     //opening the configuration file.
     char *filePath = argv[1];
     int ConfigFile = openFile(filePath,READ_ONLY);
@@ -500,6 +2186,10 @@ void readConfigFile(char *const *argv,  char *studentFolders,
     readLineFromFile(ConfigFile,testInput);
     //line #3 - location of the correct output.
     readLineFromFile(ConfigFile,correctOutPut);
+    //line #4 - location of the generator, lines #5 & #6 - the reference solution & seeds.
+    readLineFromFile(ConfigFile,generator);
+    readLineFromFile(ConfigFile,reference);
+    readLineFromFile(ConfigFile,seeds);
 
 
     //closing the configuration file.
@@ -755,6 +2445,283 @@ char* findCFilePath(char *cpath) {
     }
 }
 
+/**
+ * the function runs every compiled c file on inputs generated from seeds,
+ * comparing its output to the output of the reference solution.
+ * the inputs & the reference outputs are generated once for the whole cohort.
+ * @param pStudents - the array of studentInfo.
+ * @param submissionsCount - the amount of submissions.
+ * @param generator - the program generating an input from the seed passed as its argument.
+ * @param reference - the reference solution.
+ * @param seedsCount - the amount of seeds every submission is tested on.
+ * @param pSandbox - the zygote running the programs.
+ * @param pController - the controller deciding the size of the batches.
+ * @return - 1 if the tests ran, 0 if they were skipped since the generator or the reference failed.
+ */
+int runDifferentialTests(studentInfo *pStudents, int submissionsCount, char *generator, char *reference,
+                         int seedsCount, sandbox *pSandbox, concurrencyController *pController) {
+    int batchSize;
+    if (mkdir(DIFFERENTIAL_FOLDER, 0755) == SYSTEM_FAIL && errno != EEXIST) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+
+    //generating the inputs & the reference outputs, without them there is nothing to test against.
+    for (int seed = 0; seed < seedsCount; seed += batchSize) {
+        batchSize = controllerLimit(pController);
+        int count = seedsCount - seed < batchSize ? seedsCount - seed : batchSize;
+        char *program = generator;
+        int failingSeed = runDifferentialBatch(pSandbox, pController, generator, seed, count, 1);
+        if (failingSeed == SYSTEM_FAIL) {
+            program = reference;
+            failingSeed = runDifferentialBatch(pSandbox, pController, reference, seed, count, 0);
+        }
+        if (failingSeed != SYSTEM_FAIL) {
+            fprintf(stderr, "%s failed on seed %d, skipping the differential tests.\n", program, failingSeed);
+            removeDifferentialFiles(seedsCount);
+            unlink("differential.csv");
+            return 0;
+        }
+    }
+    char **expected = (char **)malloc(seedsCount * sizeof(char *));
+    long *expectedSizes = (long *)malloc(seedsCount * sizeof(long));
+    if (expected == NULL || expectedSizes == NULL) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+    for (int seed = 0; seed < seedsCount; ++seed) {
+        char path[STRING_MAX_LENGTH];
+        expected[seed] = readWholeFile(seedFilePath(path, "output", seed), &expectedSizes[seed]);
+        if (expected[seed] == NULL) {
+            printError();
+            exit(SYSTEM_FAIL);
+        }
+        unlink(path);
+    }
+
+    unsigned long long *hashes = (unsigned long long *)malloc(submissionsCount * sizeof(unsigned long long));
+    if (hashes == NULL) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+    for (int i = 0; i < submissionsCount; ++i) {
+        if (pStudents[i].isGraded == 1 || hashFile(pStudents[i].compiledFileName, &hashes[i]) == 0) {
+            continue;
+        }
+        //an identical binary already tested gets the same result, confirmed byte for byte.
+        int source = 0;
+        while (source < i && (pStudents[source].differentialInfo[0] == '\0' || hashes[source] != hashes[i]
+                              || filesEqual(pStudents[source].compiledFileName, pStudents[i].compiledFileName) == 0)) {
+            source++;
+        }
+        if (source < i) {
+            pStudents[i].failingSeed = pStudents[source].failingSeed;
+            strCopy(pStudents[i].differentialInfo, pStudents[source].differentialInfo);
+            continue;
+        }
+
+        char binaryPath[STRING_MAX_LENGTH];
+        strCopy(binaryPath, "./");
+        strConcatenate(binaryPath, pStudents[i].compiledFileName);
+        strCopy(pStudents[i].differentialInfo, "PASS");
+
+        //the batches go by the order of the seeds, so the first failing batch holds the first failing seed.
+        for (int seed = 0; seed < seedsCount && pStudents[i].failingSeed == SYSTEM_FAIL; seed += batchSize) {
+            batchSize = controllerLimit(pController);
+            int count = seedsCount - seed < batchSize ? seedsCount - seed : batchSize;
+            for (int j = 0; j < count; ++j) {
+                char inputPath[STRING_MAX_LENGTH];
+                char outputPath[STRING_MAX_LENGTH];
+                int inputFD = open(seedFilePath(inputPath, "input", seed + j), O_RDONLY);
+                int outputFD = open(seedFilePath(outputPath, "output", seed + j),
+                                    O_CREAT | O_TRUNC | O_WRONLY, 0644);
+                if (inputFD < 0 || outputFD < 0) {
+                    printError();
+                    exit(SYSTEM_FAIL);
+                }
+                sandboxSubmit(pSandbox, seed + j, binaryPath, NULL, inputFD, outputFD, RUN_TIME_LIMIT);
+                closeFile(inputFD);
+                closeFile(outputFD);
+            }
+            for (int j = 0; j < count; ++j) {
+                sandboxResult result;
+                char outputPath[STRING_MAX_LENGTH];
+                sandboxCollect(pSandbox, &result);
+                controllerObserve(pController, result.elapsedMs, &result.usage, RUN_TIME_LIMIT);
+                seedFilePath(outputPath, "output", result.runId);
+
+                char *info = NULL;
+                if (result.timedOut == 1) {
+                    info = "TIMEOUT";
+                } else {
+                    long actualSize;
+                    char *actual = readWholeFile(outputPath, &actualSize);
+                    int k = 0;
+                    int isEqual = actual != NULL && actualSize == expectedSizes[result.runId];
+                    while (isEqual && k < actualSize) {
+                        isEqual = actual[k] == expected[result.runId][k];
+                        k++;
+                    }
+                    if (!isEqual) {
+                        info = "BAD_OUTPUT";
+                    }
+                    free(actual);
+                }
+                unlink(outputPath);
+
+                if (info != NULL && (pStudents[i].failingSeed == SYSTEM_FAIL
+                                     || result.runId < pStudents[i].failingSeed)) {
+                    pStudents[i].failingSeed = result.runId;
+                    strCopy(pStudents[i].differentialInfo, info);
+                }
+            }
+        }
+    }
+
+    for (int seed = 0; seed < seedsCount; ++seed) {
+        free(expected[seed]);
+    }
+    removeDifferentialFiles(seedsCount);
+    free(hashes);
+    free(expected);
+    free(expectedSizes);
+    return 1;
+}
+
+/**
+ * the function deletes the inputs & outputs of the differential tests, and their folder.
+ * @param seedsCount - the amount of seeds the files were generated for.
+ */
+void removeDifferentialFiles(int seedsCount) {
+    for (int seed = 0; seed < seedsCount; ++seed) {
+        char path[STRING_MAX_LENGTH];
+        unlink(seedFilePath(path, "input", seed));
+        unlink(seedFilePath(path, "output", seed));
+    }
+    rmdir(DIFFERENTIAL_FOLDER);
+}
+
+/**
+ * the function runs the generator or the reference solution on a batch of seeds in parallel.
+ * the generator gets the seed as an argument & writes the input of the seed,
+ * the reference solution reads the input of the seed & writes its output.
+ * @param pSandbox - the zygote running the programs.
+ * @param pController - the controller the latency of the runs is reported to.
+ * @param binaryPath - the program we would like to run.
+ * @param firstSeed - the first seed of the batch.
+ * @param count - the amount of seeds in the batch.
+ * @param isGenerator - 1 if the program is the generator, else 0.
+ * @return - the first seed the program failed or timed out on, SYSTEM_FAIL if it succeeded on all of them.
+ */
+int runDifferentialBatch(sandbox *pSandbox, concurrencyController *pController, char *binaryPath,
+                         int firstSeed, int count, int isGenerator) {
+    int failingSeed = SYSTEM_FAIL;
+    for (int j = 0; j < count; ++j) {
+        char seed[STRING_MAX_LENGTH];
+        char inputPath[STRING_MAX_LENGTH];
+        char outputPath[STRING_MAX_LENGTH];
+        int inputFD;
+        int outputFD;
+        itoa(firstSeed + j, seed);
+        if (isGenerator == 1) {
+            inputFD = open("/dev/null", O_RDONLY);
+            outputFD = open(seedFilePath(outputPath, "input", firstSeed + j), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+        } else {
+            inputFD = open(seedFilePath(inputPath, "input", firstSeed + j), O_RDONLY);
+            outputFD = open(seedFilePath(outputPath, "output", firstSeed + j), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+        }
+        if (inputFD < 0 || outputFD < 0) {
+            printError();
+            exit(SYSTEM_FAIL);
+        }
+        sandboxSubmit(pSandbox, firstSeed + j, binaryPath, isGenerator == 1 ? seed : NULL,
+                      inputFD, outputFD, RUN_TIME_LIMIT);
+        closeFile(inputFD);
+        closeFile(outputFD);
+    }
+
+    //every result of the batch is collected, even after a failure.
+    for (int j = 0; j < count; ++j) {
+        sandboxResult result;
+        sandboxCollect(pSandbox, &result);
+        controllerObserve(pController, result.elapsedMs, &result.usage, RUN_TIME_LIMIT);
+        if ((result.timedOut == 1 || !WIFEXITED(result.status) || WEXITSTATUS(result.status) != 0)
+            && (failingSeed == SYSTEM_FAIL || result.runId < failingSeed)) {
+            failingSeed = result.runId;
+        }
+    }
+    return failingSeed;
+}
+
+/**
+ * the function parses the amount of seeds, line #6 of the config file.
+ * @param seeds - the line, empty for the default amount.
+ * @return - the amount of seeds, exits if the line isn't a positive integer.
+ */
+int parseSeedsCount(char *seeds) {
+    if (seeds[0] == '\0') {
+        return DIFFERENTIAL_DEFAULT_SEEDS;
+    }
+    char *end;
+    errno = 0;
+    long seedsCount = strtol(seeds, &end, 10);
+    if (errno != 0 || end == seeds || *end != '\0' || seedsCount <= 0 || seedsCount > INT_MAX) {
+        fprintf(stderr, "Config line 6: the amount of seeds must be a positive integer, got \"%s\".\n", seeds);
+        exit(SYSTEM_FAIL);
+    }
+    return (int)seedsCount;
+}
+
+/**
+ * the function builds the path of a file of the differential tests.
+ * @param path - the location we would like to save the path to.
+ * @param kind - the kind of the file, "input" or "output".
+ * @param seed - the seed the file belongs to.
+ * @return - a pointer to the path.
+ */
+char *seedFilePath(char *path, char *kind, int seed) {
+    char num[STRING_MAX_LENGTH];
+    strCopy(path, DIFFERENTIAL_FOLDER);
+    strConcatenate(path, "/");
+    strConcatenate(path, kind);
+    strConcatenate(path, "_");
+    strConcatenate(path, itoa(seed, num));
+    strConcatenate(path, ".txt");
+    return path;
+}
+
+/**
+ * the function writes the results of the differential tests to a csv file,
+ * a failing submission is written with the first seed it failed on.
+ * @param pStudents - the array of studentInfo.
+ * @param submissionsCount - the amount of submissions.
+ */
+void writeDifferentialCSV(studentInfo *pStudents, int submissionsCount) {
+    int differentialCsvFD = open("differential.csv", O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if (differentialCsvFD == SYSTEM_FAIL) {
+        printError();
+        exit(SYSTEM_FAIL);
+    }
+    for (int i = 0; i < submissionsCount; ++i) {
+        if (pStudents[i].differentialInfo[0] == '\0') {
+            continue;
+        }
+        int checkWrite;
+        if (pStudents[i].failingSeed == SYSTEM_FAIL) {
+            checkWrite = dprintf(differentialCsvFD, "%s,%s\n", pStudents[i].name, pStudents[i].differentialInfo);
+        } else {
+            checkWrite = dprintf(differentialCsvFD, "%s,%s,%d\n", pStudents[i].name,
+                                 pStudents[i].differentialInfo, pStudents[i].failingSeed);
+        }
+        if (checkWrite < 0) {
+            printError();
+            closeFile(differentialCsvFD);
+            exit(SYSTEM_FAIL);
+        }
+    }
+    closeFile(differentialCsvFD);
+}
+
 /**
  * the function writes the students name,grade,etc to a csv file.
  * @param pStudents - the array containing the grades/names/info of the students.
@@ -791,6 +2758,9 @@ char *studentToString(studentInfo *pStudents, int i) {
     strConcatenate(string,pStudents[i].grade);
     strConcatenate(string,",");
     strConcatenate(string,pStudents[i].info);
+    if (pStudents[i].isDeduplicated == 1) {
+        strConcatenate(string,",DEDUPLICATED");
+    }
     strConcatenate(string, "\n");
     strConcatenate(string,"\0");
     return string;